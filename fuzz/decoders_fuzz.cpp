@@ -0,0 +1,44 @@
+// libFuzzer target for the checked decoders: every input is handed to each
+// decoder, which must either decode it or throw runtime_error. Any other
+// exception escapes and is reported as a crash, as are the memory errors
+// and undefined behaviour caught by the sanitizers. Build with 'make fuzz'.
+
+#include "lz77.h"
+#include "lzss.h"
+#include "lz78.h"
+#include "parallel_lzss.h"
+#include "filtered_compression.h"
+#include "checksummed_compression.h"
+
+using namespace std;
+
+static vector<unique_ptr<CompressionAlgorithm>> makeDecoders() {
+    vector<unique_ptr<CompressionAlgorithm>> decoders;
+    decoders.push_back(make_unique<LZ77>());
+    decoders.push_back(make_unique<LZSS>());
+    decoders.push_back(make_unique<LZ78>());
+    decoders.push_back(make_unique<LZ78>(4096));
+    decoders.push_back(make_unique<ParallelLZSS>(64 * 1024, 2));
+    decoders.push_back(make_unique<ParallelLZSS>(4096, 1, true, 32 * 1024));
+    decoders.push_back(make_unique<FilteredCompression>(
+        make_unique<LZSS>(), vector<FilterSpec>{{FilterType::DELTA, 4}, {FilterType::SHUFFLE, 4}}));
+    decoders.push_back(make_unique<FilteredCompression>(
+        make_unique<LZ78>(), vector<FilterSpec>{{FilterType::X86_BCJ}, {FilterType::DELTA, 3}}));
+    decoders.push_back(make_unique<ChecksummedCompression>(make_unique<LZSS>(), 1000));
+    decoders.push_back(make_unique<ChecksummedCompression>(make_unique<ParallelLZSS>(1000, 2)));
+    return decoders;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static vector<unique_ptr<CompressionAlgorithm>> decoders = makeDecoders();
+
+    vector<uint8_t> input(data, data + size);
+    for (auto& decoder : decoders) {
+        try {
+            decoder->decompress(input);
+        } catch (const runtime_error&) {
+            // Rejected as corrupt: the expected outcome for most inputs
+        }
+    }
+    return 0;
+}
@@ -17,18 +17,25 @@ class BitWriter {
     BitWriter(vector<uint8_t>& out);
     void writeBits(uint32_t value, int bits);
     void flush();
+    // Bits in the output so far, including those not yet flushed
+    size_t bitPosition() const { return output.size() * 8 + bitCount; }
 
 };
 
 
 class BitReader {
     private:
-    const vector<uint8_t>& input;
+    const uint8_t* input;
+    size_t inputSize;
     size_t bytePos;
     int bitPos;
     public:
     BitReader(const vector<uint8_t>& in);
+    // Reads a sub-range of a larger buffer without copying it
+    BitReader(const uint8_t* in, size_t size);
     uint32_t readBits(int bits);
     bool hasMoreBits() const;
+    size_t bitsRemaining() const;
+    size_t bitPosition() const { return bytePos * 8 + bitPos; }
 };
 #endif
\ No newline at end of file
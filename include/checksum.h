@@ -0,0 +1,23 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// CRC32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the CPU has
+// it and a slicing-by-8 table implementation otherwise. All functions are
+// incremental: pass the previous result as crc to continue a checksum, and
+// start from 0.
+class Checksum {
+public:
+    static uint32_t crc32c(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+    // Individual implementations, exposed for benchmarking
+    static uint32_t crc32cSoftware(const uint8_t* data, size_t length, uint32_t crc = 0);
+    static uint32_t crc32cHardware(const uint8_t* data, size_t length, uint32_t crc = 0);
+    static bool hasHardwareCrc32c();
+};
+
+#endif
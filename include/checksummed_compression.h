@@ -0,0 +1,60 @@
+#ifndef CHECKSUMMED_COMPRESSION_H
+#define CHECKSUMMED_COMPRESSION_H
+
+#include "compression_base.h"
+#include "checksum.h"
+
+using namespace std;
+
+// Adds CRC32C integrity checking to any CompressionAlgorithm without
+// changing how it compresses: the input is compressed as one inner stream,
+// exactly as the inner algorithm would on its own.
+//
+// The stream is checked in chunks of at least rangeSize raw bytes that
+// follow the inner algorithm's own progress (see ProgressHooks). For each
+// chunk the encoder records where its tokens start in the inner stream, a
+// CRC32C of its raw bytes, taken as the encoder finishes the chunk, and a
+// CRC32C of its compressed bytes. While decoding, each chunk's compressed
+// bytes are verified just before the inner decoder reads them, so it never
+// sees a damaged token and can safely run unchecked, and its raw bytes are
+// verified as soon as they are final. Inner algorithms that do not report
+// progress form a single chunk whose stream is verified before decoding.
+//
+// Stream layout (all header fields are 32-bit, MSB first):
+//   rawSize, rangeSize, streamSize, chunkCount,
+//   crc32c of the inner stream bytes before the first chunk,
+//   then per chunk: raw start, stream byte of its first token,
+//   raw crc32c, stream crc32c; then a crc32c of all preceding header
+//   bytes, followed by the inner stream
+class ChecksummedCompression : public CompressionAlgorithm {
+private:
+    static constexpr int DEFAULT_RANGE_SIZE = 64 * 1024;
+    static constexpr size_t FIXED_HEADER_SIZE = 24;
+    static constexpr size_t CHUNK_ENTRY_SIZE = 16;
+
+    struct Chunk {
+        size_t rawStart;
+        size_t streamByte; // Byte holding the chunk's first token bit
+        uint32_t rawCrc;
+        uint32_t streamCrc;
+    };
+
+    unique_ptr<CompressionAlgorithm> inner;
+    int rangeSize;
+
+    // End of the stream bytes checked by the chunk before chunks[next]
+    // (or by the bytes before the first chunk). It includes the byte where
+    // chunks[next] starts, since a token boundary can fall inside it.
+    static size_t streamRegionEnd(const vector<Chunk>& chunks, size_t next, size_t streamSize);
+
+public:
+    ChecksummedCompression(unique_ptr<CompressionAlgorithm> inner,
+                           int rangeSize = DEFAULT_RANGE_SIZE);
+
+    vector<uint8_t> compress(const vector<uint8_t>& data) override;
+    vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+};
+
+#endif
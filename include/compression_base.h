@@ -8,15 +8,79 @@
 #include <stdexcept>
 #include <memory>
 #include <cstdint>
+#include <functional>
 
 using namespace std;
 
+// Peak heap memory of a single compress()/decompress() call for a given
+// input size: the output buffer plus all working state, not counting the
+// caller's input buffer. Buffers are reserved once at their worst-case
+// size, so this is the peak itself; implementations whose buffers must
+// grow document the bound they report instead.
+struct MemoryRequirements
+{
+    size_t compressBytes;
+    size_t decompressBytes;
+};
+
 class CompressionAlgorithm
 {
 public:
     virtual ~CompressionAlgorithm() = default;
     virtual vector<uint8_t> compress(const vector<uint8_t> &data) = 0;
     virtual vector<uint8_t> decompress(const vector<uint8_t> &compressed) = 0;
+    // Decodes a stream that sits inside a larger buffer. The default copies
+    // it out; algorithms that can decode in place override this.
+    virtual vector<uint8_t> decompressRange(const uint8_t *compressed, size_t size) {
+        return decompress(vector<uint8_t>(compressed, compressed + size));
+    }
     virtual string getName() const = 0;
+    virtual MemoryRequirements memoryRequirements(size_t inputSize) const = 0;
+
+    // Decoders validate every token by default and throw runtime_error on
+    // corrupt or truncated input. Unchecked decoding skips the validation
+    // and must only be used on streams known to be intact.
+    void setBoundsChecked(bool enabled) { boundsChecked = enabled; }
+    bool isBoundsChecked() const { return boundsChecked; }
+
+    // Lets a wrapper follow a stream chunk by chunk. Algorithms that work
+    // front to back (LZ77, LZSS, LZ78, LZSS-Parallel) split their data into
+    // chunks at token boundaries: each chunk starts at the first boundary
+    // at least `interval` bytes after the previous one (LZSS-Parallel: one
+    // chunk per block). Encoder and decoder split a stream identically.
+    // Other algorithms never call the hooks; unset hooks are skipped.
+    struct ProgressHooks
+    {
+        size_t interval = 1;
+        // compress(): about to encode input from rawPos, with streamBit bits
+        // of stream written; called once more at the end with rawPos equal
+        // to the input size
+        function<void(const uint8_t *input, size_t rawPos, size_t streamBit)> encodeChunk;
+        // decompress(): about to decode the chunk that starts at rawPos,
+        // whose tokens start streamBit bits into the stream
+        function<void(size_t rawPos, size_t streamBit)> decodeChunk;
+        // decompress(): output[0, end) is final; called after each chunk
+        function<void(const uint8_t *output, size_t end)> outputFinal;
+    };
+    void setProgressHooks(ProgressHooks hooks) {
+        progress = move(hooks);
+        progress.interval = max<size_t>(progress.interval, 1);
+    }
+
+protected:
+    bool boundsChecked = true;
+    ProgressHooks progress;
+
+    // Requirements of a wrapper that stores an inner stream behind its own
+    // header. Compressing holds the inner call, then the inner output
+    // copied behind the header, charged at the inner peak, so that figure
+    // is an upper bound. Decompressing decodes the inner stream in place.
+    // The extra bytes are the wrapper's own buffers held alongside.
+    static MemoryRequirements wrappedRequirements(const MemoryRequirements& inner,
+                                                  size_t headerBytes, size_t extraCompress,
+                                                  size_t extraDecompress) {
+        return {inner.compressBytes * 2 + headerBytes + extraCompress,
+                inner.decompressBytes + extraDecompress};
+    }
 };
 #endif
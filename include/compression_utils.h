@@ -17,6 +17,18 @@ public:
     static string vectorToString(const vector<uint8_t> &data);
     static void printCompressionStats(const string &algorithmName,
                                       size_t originalSize, size_t compressedSize);
+
+    // Compresses data and checks that both the bounds-checked and the
+    // unchecked decoder reproduce it. Returns an empty string on success,
+    // otherwise a description of the failure.
+    static string verifyRoundTrip(CompressionAlgorithm &algo, const vector<uint8_t> &data);
+    // Feeds a damaged stream to the bounds-checked decoder, which must
+    // either decode it or throw runtime_error. With mustReject set the
+    // decoder has to throw; with original set, anything it accepts must
+    // decode to original.
+    static string verifyCorruptInput(CompressionAlgorithm &algo,
+                                     const vector<uint8_t> &corrupted, bool mustReject,
+                                     const vector<uint8_t> *original = nullptr);
 };
 
 #endif
@@ -0,0 +1,14 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Marks hot functions for function multi-versioning. When built with
+// -DLZ_MULTIVERSION, GCC compiles each marked function for baseline
+// x86-64, x86-64-v2 (SSE4.2, POPCNT) and x86-64-v3 (AVX2, BMI2), and picks
+// the best clone for the running CPU at load time.
+#if defined(LZ_MULTIVERSION) && defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define HOT_MULTIVERSION __attribute__((target_clones("default", "arch=x86-64-v2", "arch=x86-64-v3")))
+#else
+#define HOT_MULTIVERSION
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef FILTERED_COMPRESSION_H
+#define FILTERED_COMPRESSION_H
+
+#include "compression_base.h"
+#include "filters.h"
+
+using namespace std;
+
+enum class FilterType : uint8_t {
+    DELTA = 1,    // parameter: stride in bytes
+    SHUFFLE = 2,  // parameter: element size in bytes
+    X86_BCJ = 3   // parameter unused
+};
+
+struct FilterSpec {
+    FilterType type;
+    uint8_t parameter;
+
+    FilterSpec(FilterType t, uint8_t param = 0) : type(t), parameter(param) {}
+};
+
+// Runs a chain of Filters in front of any CompressionAlgorithm. Filters are
+// applied in order before compressing and undone in reverse order after
+// decompressing.
+//
+// Stream layout: filter count, then (type, parameter) per filter, one byte
+// each, followed by the inner algorithm's stream. The decoder only trusts
+// the recorded chain, so any FilteredCompression over the same inner
+// algorithm can decode the stream.
+class FilteredCompression : public CompressionAlgorithm {
+private:
+    unique_ptr<CompressionAlgorithm> inner;
+    vector<FilterSpec> filters;
+
+    static bool isValid(const FilterSpec& filter);
+    static string filterName(const FilterSpec& filter);
+
+public:
+    FilteredCompression(unique_ptr<CompressionAlgorithm> inner, vector<FilterSpec> filters);
+
+    vector<uint8_t> compress(const vector<uint8_t>& data) override;
+    vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    vector<uint8_t> decompressRange(const uint8_t* compressed, size_t compressedSize) override;
+    string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Reversible byte transforms applied before compression to expose
+// redundancy in structured binary data. Each kernel has an SSE2 path and a
+// portable scalar fallback.
+class Filters {
+public:
+    // Replaces each byte with its difference from the byte `stride`
+    // positions earlier. Suits arrays of integers and sampled signals.
+    static void deltaEncode(vector<uint8_t>& data, int stride);
+    static void deltaDecode(vector<uint8_t>& data, int stride);
+
+    // Byte-plane shuffle (as in blosc): gathers byte 0 of every
+    // elementSize-byte element, then byte 1, and so on. Trailing bytes that
+    // do not form a whole element are copied unchanged.
+    static void shuffle(const vector<uint8_t>& input, vector<uint8_t>& output, int elementSize);
+    static void unshuffle(const vector<uint8_t>& input, vector<uint8_t>& output, int elementSize);
+
+    // x86 branch converter (BCJ): rewrites the relative targets of E8/E9
+    // CALL/JMP instructions as absolute addresses, so repeated calls to the
+    // same function become identical byte strings.
+    static void x86Encode(vector<uint8_t>& data);
+    static void x86Decode(vector<uint8_t>& data);
+};
+
+#endif
@@ -9,9 +9,10 @@ using namespace std;
 
 class LZ77 : public CompressionAlgorithm {
 private:
-    static const int WINDOW_SIZE = 4096;
-    static const int LOOKAHEAD_SIZE = 18;
-    static const int MIN_MATCH_LENGTH = 3;
+    static constexpr int WINDOW_SIZE = 4096;
+    static constexpr int LOOKAHEAD_SIZE = 18;
+    static constexpr int MIN_MATCH_LENGTH = 3;
+    static constexpr int LENGTH_BITS = 4;
 
     struct Match {
         int offset;
@@ -27,7 +28,13 @@ private:
 public:
     vector<uint8_t> compress(const vector<uint8_t>& data) override;
     vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    vector<uint8_t> decompressRange(const uint8_t* compressed, size_t compressedSize) override;
     string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+
+    // Stream layout: 32-bit original size (MSB first), then the tokens
+    static size_t maxCompressedSize(size_t inputSize);
+    static size_t maxDecompressedSize(size_t compressedSize);
 };
 
 #endif 
\ No newline at end of file
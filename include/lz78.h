@@ -3,25 +3,63 @@
 
 #include "compression_base.h"
 #include "bit_utils.h"
-#include <unordered_map>
 
 using namespace std;
 
+// Stream layout: one byte holding the dictionary index width in bits, the
+// 32-bit original size (MSB first), then (index, character) pairs. The last
+// pair omits its character when the input ends inside a dictionary match.
 class LZ78 : public CompressionAlgorithm {
 private:
     struct DictEntry {
         int parent;
+        uint16_t length;
         uint8_t character;
-        
-        DictEntry(int p = -1, uint8_t c = 0) : parent(p), character(c) {}
+
+        DictEntry(int p = -1, uint16_t len = 0, uint8_t c = 0)
+            : parent(p), length(len), character(c) {}
+    };
+
+    // Open-addressing slot mapping (parent index, next byte) to the child
+    // entry. A key of 0 marks an empty slot.
+    struct TrieSlot {
+        uint32_t key;
+        uint32_t child;
     };
 
-    static const int MAX_DICT_SIZE = 65536;
+    static constexpr int MIN_DICT_BITS = 8;
+    static constexpr int MAX_DICT_BITS = 16;
+    // Initial output capacity of a checked decode, per stream byte
+    static constexpr size_t CHECKED_RESERVE_RATIO = 4;
+
+    int dictBits;
+    size_t workingStateBudget; // 0 when unbudgeted
+
+    // The trie table is kept at most half full
+    static size_t trieCapacity(int bits) { return (size_t)2 << bits; }
+    static size_t compressWorkingBytes(int bits);
+    static size_t decompressWorkingBytes(int bits);
+    template <bool Checked>
+    void decodeTokens(BitReader& reader, int bits, vector<uint8_t>& output, size_t size) const;
 
 public:
+    // workingStateBudget caps the dictionary tables in bytes (not the
+    // input or output buffers counted by memoryRequirements) by choosing a
+    // smaller dictionary; 0 selects the full 65536-entry dictionary. Throws
+    // invalid_argument if even the 256-entry dictionary does not fit. A
+    // budgeted instance rejects streams whose dictionary exceeds the budget
+    // with runtime_error.
+    explicit LZ78(size_t workingStateBudget = 0);
+
     vector<uint8_t> compress(const vector<uint8_t>& data) override;
     vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    vector<uint8_t> decompressRange(const uint8_t* compressed, size_t compressedSize) override;
     string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+
+    int getDictionaryBits() const { return dictBits; }
+    static size_t maxCompressedSize(size_t inputSize, int dictBits);
+    static size_t maxDecompressedSize(size_t compressedSize, int dictBits);
 };
 
-#endif 
\ No newline at end of file
+#endif
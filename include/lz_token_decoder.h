@@ -0,0 +1,81 @@
+#ifndef LZ_TOKEN_DECODER_H
+#define LZ_TOKEN_DECODER_H
+
+#include "compression_base.h"
+#include "bit_utils.h"
+
+using namespace std;
+
+// Token stream shared by LZ77, LZSS and LZSS-Parallel: a 1-bit flag, then
+// either an 8-bit literal or a 12-bit match offset followed by the match
+// length minus MIN_MATCH_LENGTH in lengthBits bits. The streams differ only
+// in lengthBits, so all of their validation lives here.
+class LZTokenDecoder {
+public:
+    static constexpr int OFFSET_BITS = 12;
+    static constexpr int MIN_MATCH_LENGTH = 3;
+
+    // Decodes tokens into output from pos until pos reaches stopAt and
+    // returns the new position. Matches may not run past end and may reach
+    // back as far as historyStart. Each match is first offered to
+    // defer(pos, length, offset); when that returns true the caller has
+    // taken the match over and its bytes are left untouched.
+    template <bool Checked, typename Defer>
+    static size_t decode(BitReader& reader, int lengthBits, uint8_t* output, size_t pos,
+                         size_t stopAt, size_t end, size_t historyStart, const char* name,
+                         Defer&& defer);
+
+    // Decodes a complete stream of size bytes chunk by chunk, calling the
+    // decode hooks that are set, then checks its end
+    template <bool Checked>
+    static void decodeStream(BitReader& reader, int lengthBits, uint8_t* output, size_t size,
+                             const char* name,
+                             const CompressionAlgorithm::ProgressHooks& progress);
+
+    // Only the zero padding of the final byte may follow the last token
+    static void checkEnd(BitReader& reader, const char* name);
+
+private:
+    [[noreturn]] static void fail(const char* name, const char* problem);
+};
+
+template <bool Checked, typename Defer>
+size_t LZTokenDecoder::decode(BitReader& reader, int lengthBits, uint8_t* output, size_t pos,
+                              size_t stopAt, size_t end, size_t historyStart, const char* name,
+                              Defer&& defer) {
+    while (pos < stopAt) {
+        if (Checked && reader.bitsRemaining() < 9) {
+            fail(name, "truncated data");
+        }
+
+        if (reader.readBits(1) == 0) {
+            // Literal
+            output[pos++] = reader.readBits(8);
+            continue;
+        }
+
+        // Match
+        if (Checked && reader.bitsRemaining() < (size_t)(OFFSET_BITS + lengthBits)) {
+            fail(name, "truncated data");
+        }
+        uint32_t offset = reader.readBits(OFFSET_BITS);
+        uint32_t length = reader.readBits(lengthBits) + MIN_MATCH_LENGTH;
+        if (Checked && (offset == 0 || offset > pos - historyStart || length > end - pos)) {
+            fail(name, "invalid match");
+        }
+        if (defer(pos, length, offset)) {
+            pos += length;
+            continue;
+        }
+
+        // Byte by byte so overlapping matches repeat correctly
+        const uint8_t* src = output + pos - offset;
+        for (uint32_t i = 0; i < length; i++) {
+            output[pos + i] = src[i];
+        }
+        pos += length;
+    }
+    return pos;
+}
+
+#endif
@@ -9,9 +9,10 @@ using namespace std;
 
 class LZSS : public CompressionAlgorithm {
 private:
-    static const int WINDOW_SIZE = 4096;
-    static const int LOOKAHEAD_SIZE = 18;
-    static const int MIN_MATCH_LENGTH = 3;
+    static constexpr int WINDOW_SIZE = 4096;
+    static constexpr int LOOKAHEAD_SIZE = 18;
+    static constexpr int MIN_MATCH_LENGTH = 3;
+    static constexpr int LENGTH_BITS = 5;
 
     struct Match {
         int offset;
@@ -21,13 +22,34 @@ private:
         Match(int off, int len) : offset(off), length(len) {}
     };
 
-    Match findLongestMatch(const vector<uint8_t>& data, int pos);
+    // Matches may reach back to historyStart (a preset dictionary when it
+    // lies before the range being encoded) and must not run past end.
+    Match findLongestMatch(const vector<uint8_t>& data, int pos,
+                           int historyStart, int end);
     bool isMatchBeneficial(const Match& match);
+    // Encodes tokens from begin until reaching stopAt and returns the
+    // position reached; the last match may run on towards end.
+    int encodeRange(BitWriter& writer, const vector<uint8_t>& data,
+                    int begin, int stopAt, int end, int historyStart);
+
+    // Worst case size of an encoded token stream: every byte emitted as a
+    // 9-bit literal
+    static size_t maxPayloadSize(size_t inputSize);
+    // Most bytes a token stream of payloadSize bytes can describe
+    static size_t maxPayloadOutput(size_t payloadSize);
+
+    friend class ParallelLZSS;
 
 public:
     vector<uint8_t> compress(const vector<uint8_t>& data) override;
     vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    vector<uint8_t> decompressRange(const uint8_t* compressed, size_t compressedSize) override;
     string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+
+    // Stream layout: 32-bit original size (MSB first), then the tokens
+    static size_t maxCompressedSize(size_t inputSize);
+    static size_t maxDecompressedSize(size_t compressedSize);
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef PARALLEL_LZSS_H
+#define PARALLEL_LZSS_H
+
+#include "compression_base.h"
+#include "bit_utils.h"
+#include "lzss.h"
+#include <functional>
+
+using namespace std;
+
+// Block-parallel LZSS. Input is split into fixed-size blocks that are
+// compressed by independent workers. With cross-block history enabled each
+// block may also reference the last window of the preceding block as a
+// preset dictionary, which keeps the ratio close to serial LZSS.
+//
+// Stream layout (all header fields are 32-bit, MSB first):
+//   blockCount, then per block: rawSize, compressedSize
+//   followed by the concatenated LZSS bit streams of every block
+class ParallelLZSS : public CompressionAlgorithm {
+private:
+    static constexpr int DEFAULT_BLOCK_SIZE = 64 * 1024;
+    static constexpr int MIN_BUDGET_BLOCK_SIZE = 4096;
+
+    int blockSize;
+    unsigned threadCount;
+    bool crossBlockHistory;
+    size_t workingStateBudget; // 0 when unbudgeted
+
+    // A match that copies from bytes which are not final while its block is
+    // decoded: bytes of the previous block, or bytes of an earlier pending
+    // match. It is replayed once the previous block is complete.
+    struct PendingMatch {
+        uint32_t start; // Offset of the match within its block
+        uint16_t length;
+        uint16_t distance;
+    };
+
+    struct BlockInfo {
+        size_t rawStart;
+        uint32_t rawSize;
+        size_t payloadStart;
+        uint32_t payloadSize;
+    };
+
+    void runParallel(size_t count, const function<void(size_t)>& task) const;
+    template <bool Checked>
+    vector<PendingMatch> decodeBlock(const uint8_t* payload, size_t payloadSize,
+                                     vector<uint8_t>& output, size_t blockStart,
+                                     size_t blockEnd, bool hasHistory) const;
+
+    // Blocks buffered at once: one wave of threadCount blocks under a
+    // memory budget, otherwise every block
+    size_t blocksInFlight(size_t blockCount) const;
+
+    // State held per block in flight
+    static size_t compressBlockBytes(size_t blockSize);
+    static size_t decompressBlockBytes(size_t blockSize);
+
+public:
+    // A non-zero workingStateBudget (bytes) bounds the in-flight block
+    // buffers, not the input or output counted by memoryRequirements. The
+    // block size is shrunk first (down to 4096 bytes), then the thread
+    // count. Throws invalid_argument if one block in flight still does not
+    // fit. A budgeted instance decodes streams in waves that fit the budget
+    // and rejects streams whose blocks are too large with runtime_error.
+    ParallelLZSS(int blockSize = DEFAULT_BLOCK_SIZE, unsigned threads = 0,
+                 bool crossBlockHistory = true, size_t workingStateBudget = 0);
+
+    vector<uint8_t> compress(const vector<uint8_t>& data) override;
+    vector<uint8_t> decompress(const vector<uint8_t>& compressed) override;
+    vector<uint8_t> decompressRange(const uint8_t* compressed, size_t compressedSize) override;
+    string getName() const override;
+    MemoryRequirements memoryRequirements(size_t inputSize) const override;
+
+    int getBlockSize() const { return blockSize; }
+    unsigned getThreadCount() const { return threadCount; }
+    static size_t maxCompressedSize(size_t inputSize, int blockSize);
+};
+
+#endif
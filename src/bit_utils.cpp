@@ -1,10 +1,12 @@
 #include "bit_utils.h"
+#include "cpu_dispatch.h"
 
 using namespace std;
 
 
 BitWriter::BitWriter(vector<uint8_t>& out) : output(out), buffer(0), bitCount(0) {}
 
+HOT_MULTIVERSION
 void BitWriter::writeBits(uint32_t value, int bits) {
     while (bits > 0) {
         int bitsToWrite = min(bits, 8 - bitCount);
@@ -29,11 +31,15 @@ void BitWriter::flush() {
 }
 
 
-BitReader::BitReader(const vector<uint8_t>& in) : input(in), bytePos(0), bitPos(0) {}
+BitReader::BitReader(const vector<uint8_t>& in) : BitReader(in.data(), in.size()) {}
 
+BitReader::BitReader(const uint8_t* in, size_t size)
+    : input(in), inputSize(size), bytePos(0), bitPos(0) {}
+
+HOT_MULTIVERSION
 uint32_t BitReader::readBits(int bits) {
     uint32_t result = 0;
-    while (bits > 0 && bytePos < input.size()) {
+    while (bits > 0 && bytePos < inputSize) {
         int bitsToRead = min(bits, 8 - bitPos);
         uint8_t mask = (1 << bitsToRead) - 1;
         result = (result << bitsToRead) | ((input[bytePos] >> (8 - bitPos - bitsToRead)) & mask);
@@ -49,5 +55,9 @@ uint32_t BitReader::readBits(int bits) {
 }
 
 bool BitReader::hasMoreBits() const {
-    return bytePos < input.size() || bitPos > 0;
-}
\ No newline at end of file
+    return bytePos < inputSize || bitPos > 0;
+}
+
+size_t BitReader::bitsRemaining() const {
+    return bytePos < inputSize ? (inputSize - bytePos) * 8 - bitPos : 0;
+}
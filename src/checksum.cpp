@@ -0,0 +1,104 @@
+#include "checksum.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHECKSUM_X86_CRC 1
+#include <nmmintrin.h>
+#endif
+
+using namespace std;
+
+// Reflected CRC32C polynomial
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+
+// table[k][b] is the CRC of byte b followed by k zero bytes, which lets the
+// software path fold eight input bytes per step
+struct SlicingTables {
+    uint32_t table[8][256];
+
+    SlicingTables() {
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+            }
+            table[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+            }
+        }
+    }
+};
+
+static const SlicingTables& slicingTables() {
+    static const SlicingTables tables;
+    return tables;
+}
+
+uint32_t Checksum::crc32cSoftware(const uint8_t* data, size_t length, uint32_t crc) {
+    const auto& t = slicingTables().table;
+    crc = ~crc;
+
+    while (length >= 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, data, 4);
+        memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+              t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+              t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return ~crc;
+}
+
+#ifdef CHECKSUM_X86_CRC
+__attribute__((target("sse4.2")))
+static uint32_t crc32cSSE42(const uint8_t* data, size_t length, uint32_t crc) {
+    uint64_t state = ~crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        state = _mm_crc32_u64(state, word);
+        data += 8;
+        length -= 8;
+    }
+    uint32_t tail = state;
+    while (length-- > 0) {
+        tail = _mm_crc32_u8(tail, *data++);
+    }
+    return ~tail;
+}
+#endif
+
+bool Checksum::hasHardwareCrc32c() {
+#ifdef CHECKSUM_X86_CRC
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+uint32_t Checksum::crc32cHardware(const uint8_t* data, size_t length, uint32_t crc) {
+#ifdef CHECKSUM_X86_CRC
+    if (hasHardwareCrc32c()) {
+        return crc32cSSE42(data, length, crc);
+    }
+#endif
+    return crc32cSoftware(data, length, crc);
+}
+
+uint32_t Checksum::crc32c(const uint8_t* data, size_t length, uint32_t crc) {
+    return hasHardwareCrc32c() ? crc32cHardware(data, length, crc)
+                               : crc32cSoftware(data, length, crc);
+}
@@ -0,0 +1,207 @@
+#include "checksummed_compression.h"
+#include "bit_utils.h"
+
+using namespace std;
+
+ChecksummedCompression::ChecksummedCompression(unique_ptr<CompressionAlgorithm> inner,
+                                               int rangeSize)
+    : inner(move(inner)), rangeSize(max(rangeSize, 1)) {}
+
+size_t ChecksummedCompression::streamRegionEnd(const vector<Chunk>& chunks, size_t next,
+                                               size_t streamSize) {
+    return next < chunks.size() ? min(streamSize, chunks[next].streamByte + 1) : streamSize;
+}
+
+vector<uint8_t> ChecksummedCompression::compress(const vector<uint8_t>& data) {
+    // Each chunk's raw CRC is taken as the inner encoder moves past it,
+    // while its input is still in cache. Inner chunks shorter than
+    // rangeSize (such as small LZSS-Parallel blocks) are merged.
+    vector<Chunk> chunks;
+    chunks.reserve((data.size() + rangeSize - 1) / rangeSize);
+    size_t crcEnd = 0;
+    bool reported = false;
+    ProgressHooks hooks;
+    hooks.interval = rangeSize;
+    hooks.encodeChunk = [&](const uint8_t* input, size_t rawPos, size_t streamBit) {
+        reported = true;
+        if (!chunks.empty()) {
+            chunks.back().rawCrc =
+                Checksum::crc32c(input + crcEnd, rawPos - crcEnd, chunks.back().rawCrc);
+        }
+        crcEnd = rawPos;
+        if (rawPos < data.size() &&
+            (chunks.empty() || rawPos - chunks.back().rawStart >= (size_t)rangeSize)) {
+            chunks.push_back({rawPos, streamBit / 8, 0, 0});
+        }
+    };
+
+    inner->setProgressHooks(hooks);
+    vector<uint8_t> stream;
+    try {
+        stream = inner->compress(data);
+    } catch (...) {
+        inner->setProgressHooks({});
+        throw;
+    }
+    inner->setProgressHooks({});
+
+    // Without progress reports the whole stream precedes the only chunk
+    if (!reported) {
+        chunks.assign(1, {0, stream.size(), Checksum::crc32c(data.data(), data.size()), 0});
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        size_t start = chunks[i].streamByte;
+        size_t end = streamRegionEnd(chunks, i + 1, stream.size());
+        chunks[i].streamCrc = Checksum::crc32c(stream.data() + start, end - start);
+    }
+
+    size_t headerSize = FIXED_HEADER_SIZE + chunks.size() * CHUNK_ENTRY_SIZE;
+    vector<uint8_t> compressed;
+    compressed.reserve(headerSize + stream.size());
+    BitWriter writer(compressed);
+    writer.writeBits(data.size(), 32);
+    writer.writeBits(rangeSize, 32);
+    writer.writeBits(stream.size(), 32);
+    writer.writeBits(chunks.size(), 32);
+    writer.writeBits(Checksum::crc32c(stream.data(), streamRegionEnd(chunks, 0, stream.size())),
+                     32);
+    for (const Chunk& chunk : chunks) {
+        writer.writeBits(chunk.rawStart, 32);
+        writer.writeBits(chunk.streamByte, 32);
+        writer.writeBits(chunk.rawCrc, 32);
+        writer.writeBits(chunk.streamCrc, 32);
+    }
+    writer.writeBits(Checksum::crc32c(compressed.data(), compressed.size()), 32);
+    writer.flush();
+
+    compressed.insert(compressed.end(), stream.begin(), stream.end());
+    return compressed;
+}
+
+vector<uint8_t> ChecksummedCompression::decompress(const vector<uint8_t>& compressed) {
+    if (compressed.size() < FIXED_HEADER_SIZE) {
+        throw runtime_error("Corrupt checksummed stream: truncated header");
+    }
+
+    BitReader header(compressed);
+    size_t rawSize = header.readBits(32);
+    size_t storedRangeSize = header.readBits(32);
+    size_t streamSize = header.readBits(32);
+    size_t chunkCount = header.readBits(32);
+    uint32_t headCrc = header.readBits(32);
+    if (chunkCount > (compressed.size() - FIXED_HEADER_SIZE) / CHUNK_ENTRY_SIZE) {
+        throw runtime_error("Corrupt checksummed stream: truncated header");
+    }
+    size_t headerSize = FIXED_HEADER_SIZE + chunkCount * CHUNK_ENTRY_SIZE;
+    if (compressed.size() - headerSize != streamSize) {
+        throw runtime_error("Corrupt checksummed stream: stream size mismatch");
+    }
+
+    // The chunk table decides which bytes get verified, so it is checked
+    // before any of it is used
+    BitReader storedHeaderCrc(compressed.data() + headerSize - 4, 4);
+    if (Checksum::crc32c(compressed.data(), headerSize - 4) != storedHeaderCrc.readBits(32)) {
+        throw runtime_error("Corrupt checksummed stream: header checksum mismatch");
+    }
+
+    vector<Chunk> chunks(chunkCount);
+    for (size_t i = 0; i < chunkCount; i++) {
+        Chunk& chunk = chunks[i];
+        chunk.rawStart = header.readBits(32);
+        chunk.streamByte = header.readBits(32);
+        chunk.rawCrc = header.readBits(32);
+        chunk.streamCrc = header.readBits(32);
+        bool ordered = i == 0 ? chunk.rawStart == 0
+                              : chunk.rawStart > chunks[i - 1].rawStart &&
+                                    chunk.rawStart < rawSize &&
+                                    chunk.streamByte >= chunks[i - 1].streamByte;
+        if (!ordered || chunk.streamByte > streamSize) {
+            throw runtime_error("Corrupt checksummed stream: invalid chunk table");
+        }
+    }
+    if (storedRangeSize == 0 || (chunkCount == 0 && rawSize != 0)) {
+        throw runtime_error("Corrupt checksummed stream: invalid chunk table");
+    }
+
+    const uint8_t* stream = compressed.data() + headerSize;
+    auto verifyStream = [&](size_t start, size_t end, uint32_t crc) {
+        if (Checksum::crc32c(stream + start, end - start) != crc) {
+            throw runtime_error("Corrupt checksummed stream: checksum mismatch in stream bytes " +
+                                to_string(start) + "-" + to_string(end));
+        }
+    };
+    verifyStream(0, streamRegionEnd(chunks, 0, streamSize), headCrc);
+
+    // A chunk's stream bytes are verified when the inner decoder is about
+    // to start on it. Inner chunks that were merged into a verified chunk
+    // start inside its bytes.
+    size_t verifiedChunks = 0;
+    auto verifyChunk = [&](size_t rawPos, size_t streamBit) {
+        size_t i = verifiedChunks;
+        if (i < chunkCount && chunks[i].rawStart == rawPos) {
+            if (chunks[i].streamByte != streamBit / 8) {
+                throw runtime_error("Corrupt checksummed stream: chunk boundary mismatch");
+            }
+            verifyStream(chunks[i].streamByte, streamRegionEnd(chunks, i + 1, streamSize),
+                         chunks[i].streamCrc);
+            verifiedChunks++;
+        } else if (i == 0 || streamBit / 8 < chunks[i - 1].streamByte ||
+                   streamBit / 8 >= streamRegionEnd(chunks, i, streamSize)) {
+            throw runtime_error("Corrupt checksummed stream: chunk boundary mismatch");
+        }
+    };
+
+    // Raw bytes are verified as soon as a whole chunk of them is final
+    size_t verifiedRaw = 0;
+    auto verifyOutput = [&](const uint8_t* output, size_t end) {
+        end = min(end, rawSize);
+        while (verifiedRaw < chunkCount) {
+            size_t start = chunks[verifiedRaw].rawStart;
+            size_t chunkEnd = verifiedRaw + 1 < chunkCount ? chunks[verifiedRaw + 1].rawStart
+                                                           : rawSize;
+            if (chunkEnd > end) break;
+            if (Checksum::crc32c(output + start, chunkEnd - start) != chunks[verifiedRaw].rawCrc) {
+                throw runtime_error("Corrupt checksummed stream: checksum mismatch in chunk " +
+                                    to_string(verifiedRaw));
+            }
+            verifiedRaw++;
+        }
+    };
+
+    ProgressHooks hooks;
+    hooks.interval = storedRangeSize;
+    hooks.decodeChunk = verifyChunk;
+    hooks.outputFinal = verifyOutput;
+    inner->setBoundsChecked(boundsChecked);
+    inner->setProgressHooks(hooks);
+    vector<uint8_t> decompressed;
+    try {
+        decompressed = inner->decompressRange(stream, streamSize);
+    } catch (...) {
+        inner->setProgressHooks({});
+        throw;
+    }
+    inner->setProgressHooks({});
+
+    if (decompressed.size() != rawSize) {
+        throw runtime_error("Corrupt checksummed stream: size mismatch");
+    }
+    // Chunks the inner decoder did not report
+    verifyOutput(decompressed.data(), rawSize);
+
+    return decompressed;
+}
+
+string ChecksummedCompression::getName() const {
+    return inner->getName() + "+crc32c";
+}
+
+MemoryRequirements ChecksummedCompression::memoryRequirements(size_t inputSize) const {
+    // Every chunk but the last spans at least rangeSize raw bytes
+    size_t chunkCount = max<size_t>(1, (inputSize + rangeSize - 1) / rangeSize);
+    size_t header = FIXED_HEADER_SIZE + chunkCount * CHUNK_ENTRY_SIZE;
+
+    // Both directions also hold the chunk table
+    size_t table = chunkCount * sizeof(Chunk);
+    return wrappedRequirements(inner->memoryRequirements(inputSize), header, table, table);
+}
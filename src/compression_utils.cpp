@@ -18,7 +18,12 @@ void CompressionUtils::testAlgorithm(unique_ptr<CompressionAlgorithm> algo,
     
     printCompressionStats(algo->getName(), testData.size(), compressed.size());
     
-    auto decompressed = algo->decompress(compressed);
+    vector<uint8_t> decompressed;
+    try {
+        decompressed = algo->decompress(compressed);
+    } catch (const runtime_error& e) {
+        cout << "ERROR: " << e.what() << "\n";
+    }
     
     bool isCorrect = (testData == decompressed);
     cout << "Decompression: " << (isCorrect ? "SUCCESS ✓" : "FAILED ✗") << "\n";
@@ -65,4 +70,52 @@ void CompressionUtils::printCompressionStats(const string& algorithmName,
     cout << "Compression ratio: " << ratio << "%\n";
     cout << "Space savings: " << savings << "%\n";
     cout << "Size reduction: " << (originalSize - compressedSize) << " bytes\n";
-}
\ No newline at end of file
+}
+
+string CompressionUtils::verifyRoundTrip(CompressionAlgorithm& algo, const vector<uint8_t>& data) {
+    bool wasChecked = algo.isBoundsChecked();
+    string error;
+    
+    try {
+        auto compressed = algo.compress(data);
+        
+        algo.setBoundsChecked(true);
+        if (algo.decompress(compressed) != data) {
+            error = "checked decode differs from input";
+        } else {
+            algo.setBoundsChecked(false);
+            if (algo.decompress(compressed) != data) {
+                error = "unchecked decode differs from input";
+            }
+        }
+    } catch (const exception& e) {
+        error = string("unexpected exception: ") + e.what();
+    }
+    
+    algo.setBoundsChecked(wasChecked);
+    return error;
+}
+
+string CompressionUtils::verifyCorruptInput(CompressionAlgorithm& algo,
+                                            const vector<uint8_t>& corrupted, bool mustReject,
+                                            const vector<uint8_t>* original) {
+    bool wasChecked = algo.isBoundsChecked();
+    algo.setBoundsChecked(true);
+    string error;
+    
+    try {
+        auto decompressed = algo.decompress(corrupted);
+        if (mustReject) {
+            error = "corrupt stream was accepted";
+        } else if (original && decompressed != *original) {
+            error = "corrupt stream decoded to wrong data";
+        }
+    } catch (const runtime_error&) {
+        // Expected rejection
+    } catch (const exception& e) {
+        error = string("wrong exception type: ") + e.what();
+    }
+    
+    algo.setBoundsChecked(wasChecked);
+    return error;
+}
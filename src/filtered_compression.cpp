@@ -0,0 +1,140 @@
+#include "filtered_compression.h"
+
+using namespace std;
+
+FilteredCompression::FilteredCompression(unique_ptr<CompressionAlgorithm> inner,
+                                         vector<FilterSpec> filters)
+    : inner(move(inner)), filters(move(filters)) {
+    if (this->filters.size() > 255) {
+        throw invalid_argument("Too many filters");
+    }
+    for (const FilterSpec& filter : this->filters) {
+        if (!isValid(filter)) {
+            throw invalid_argument("Invalid filter: " + filterName(filter));
+        }
+    }
+}
+
+bool FilteredCompression::isValid(const FilterSpec& filter) {
+    switch (filter.type) {
+    case FilterType::DELTA:
+    case FilterType::SHUFFLE:
+        return filter.parameter > 0;
+    case FilterType::X86_BCJ:
+        return true;
+    }
+    return false;
+}
+
+string FilteredCompression::filterName(const FilterSpec& filter) {
+    switch (filter.type) {
+    case FilterType::DELTA:
+        return "delta" + to_string(filter.parameter);
+    case FilterType::SHUFFLE:
+        return "shuffle" + to_string(filter.parameter);
+    case FilterType::X86_BCJ:
+        return "x86";
+    }
+    return "unknown" + to_string((int)filter.type);
+}
+
+vector<uint8_t> FilteredCompression::compress(const vector<uint8_t>& data) {
+    vector<uint8_t> filtered = data;
+    vector<uint8_t> scratch;
+
+    for (const FilterSpec& filter : filters) {
+        switch (filter.type) {
+        case FilterType::DELTA:
+            Filters::deltaEncode(filtered, filter.parameter);
+            break;
+        case FilterType::SHUFFLE:
+            Filters::shuffle(filtered, scratch, filter.parameter);
+            filtered.swap(scratch);
+            break;
+        case FilterType::X86_BCJ:
+            Filters::x86Encode(filtered);
+            break;
+        }
+    }
+    vector<uint8_t>().swap(scratch);
+
+    vector<uint8_t> payload = inner->compress(filtered);
+
+    vector<uint8_t> compressed;
+    compressed.reserve(1 + filters.size() * 2 + payload.size());
+    compressed.push_back(filters.size());
+    for (const FilterSpec& filter : filters) {
+        compressed.push_back(static_cast<uint8_t>(filter.type));
+        compressed.push_back(filter.parameter);
+    }
+    compressed.insert(compressed.end(), payload.begin(), payload.end());
+    return compressed;
+}
+
+vector<uint8_t> FilteredCompression::decompress(const vector<uint8_t>& compressed) {
+    return decompressRange(compressed.data(), compressed.size());
+}
+
+vector<uint8_t> FilteredCompression::decompressRange(const uint8_t* compressed,
+                                                     size_t compressedSize) {
+    if (compressedSize == 0) {
+        throw runtime_error("Corrupt filtered stream: truncated header");
+    }
+
+    size_t count = compressed[0];
+    size_t headerSize = 1 + count * 2;
+    if (compressedSize < headerSize) {
+        throw runtime_error("Corrupt filtered stream: truncated header");
+    }
+
+    vector<FilterSpec> chain;
+    for (size_t i = 0; i < count; i++) {
+        FilterSpec filter(static_cast<FilterType>(compressed[1 + i * 2]), compressed[2 + i * 2]);
+        if (!isValid(filter)) {
+            throw runtime_error("Corrupt filtered stream: unknown filter " + filterName(filter));
+        }
+        chain.push_back(filter);
+    }
+
+    inner->setBoundsChecked(boundsChecked);
+    vector<uint8_t> decompressed =
+        inner->decompressRange(compressed + headerSize, compressedSize - headerSize);
+
+    vector<uint8_t> scratch;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        switch (it->type) {
+        case FilterType::DELTA:
+            Filters::deltaDecode(decompressed, it->parameter);
+            break;
+        case FilterType::SHUFFLE:
+            Filters::unshuffle(decompressed, scratch, it->parameter);
+            decompressed.swap(scratch);
+            break;
+        case FilterType::X86_BCJ:
+            Filters::x86Decode(decompressed);
+            break;
+        }
+    }
+
+    return decompressed;
+}
+
+string FilteredCompression::getName() const {
+    string name = inner->getName();
+    for (const FilterSpec& filter : filters) {
+        name += "+" + filterName(filter);
+    }
+    return name;
+}
+
+MemoryRequirements FilteredCompression::memoryRequirements(size_t inputSize) const {
+    bool shuffles = false;
+    for (const FilterSpec& filter : filters) {
+        shuffles = shuffles || filter.type == FilterType::SHUFFLE;
+    }
+
+    // The filtered copy of the input, and a shuffle buffer when shuffling
+    size_t shuffleBytes = shuffles ? inputSize : 0;
+    return wrappedRequirements(inner->memoryRequirements(inputSize), 1 + filters.size() * 2,
+                               inputSize + shuffleBytes, shuffleBytes);
+}
@@ -0,0 +1,246 @@
+#include "filters.h"
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+#ifdef __SSE2__
+// Prefix sum over lanes that are `S` bytes apart, with the running totals
+// of the previous S output bytes added in. Valid for S = 1, 2, 4, 8.
+template <int S>
+static void deltaDecodeSSE2(uint8_t* p, size_t n, size_t& i) {
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+        x = _mm_add_epi8(x, _mm_slli_si128(x, S));
+        if constexpr (S <= 4) x = _mm_add_epi8(x, _mm_slli_si128(x, 2 * S));
+        if constexpr (S <= 2) x = _mm_add_epi8(x, _mm_slli_si128(x, 4 * S));
+        if constexpr (S == 1) x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+
+        __m128i carry;
+        if constexpr (S == 1) {
+            carry = _mm_set1_epi8(p[i - 1]);
+        } else if constexpr (S == 2) {
+            uint16_t last;
+            memcpy(&last, p + i - 2, 2);
+            carry = _mm_set1_epi16(last);
+        } else if constexpr (S == 4) {
+            uint32_t last;
+            memcpy(&last, p + i - 4, 4);
+            carry = _mm_set1_epi32(last);
+        } else {
+            uint64_t last;
+            memcpy(&last, p + i - 8, 8);
+            carry = _mm_set1_epi64x(last);
+        }
+        _mm_storeu_si128((__m128i*)(p + i), _mm_add_epi8(x, carry));
+    }
+}
+
+// One round of the interleave network: pairs register k with k + E/2.
+// Four rounds transpose 16 elements of E bytes into E planes; log2(E)
+// rounds undo it.
+template <int E>
+static void interleaveRound(__m128i* r) {
+    __m128i t[E];
+    for (int k = 0; k < E / 2; k++) {
+        t[2 * k] = _mm_unpacklo_epi8(r[k], r[k + E / 2]);
+        t[2 * k + 1] = _mm_unpackhi_epi8(r[k], r[k + E / 2]);
+    }
+    for (int k = 0; k < E; k++) {
+        r[k] = t[k];
+    }
+}
+
+template <int E>
+static size_t shuffleSSE2(const uint8_t* src, uint8_t* dst, size_t elements) {
+    size_t blocks = elements / 16;
+    for (size_t b = 0; b < blocks; b++) {
+        __m128i r[E];
+        for (int j = 0; j < E; j++) {
+            r[j] = _mm_loadu_si128((const __m128i*)(src + b * 16 * E + 16 * j));
+        }
+        for (int round = 0; round < 4; round++) {
+            interleaveRound<E>(r);
+        }
+        for (int plane = 0; plane < E; plane++) {
+            _mm_storeu_si128((__m128i*)(dst + plane * elements + b * 16), r[plane]);
+        }
+    }
+    return blocks * 16;
+}
+
+template <int E>
+static size_t unshuffleSSE2(const uint8_t* src, uint8_t* dst, size_t elements) {
+    constexpr int rounds = E == 2 ? 1 : E == 4 ? 2 : 3;
+    size_t blocks = elements / 16;
+    for (size_t b = 0; b < blocks; b++) {
+        __m128i r[E];
+        for (int plane = 0; plane < E; plane++) {
+            r[plane] = _mm_loadu_si128((const __m128i*)(src + plane * elements + b * 16));
+        }
+        for (int round = 0; round < rounds; round++) {
+            interleaveRound<E>(r);
+        }
+        for (int j = 0; j < E; j++) {
+            _mm_storeu_si128((__m128i*)(dst + b * 16 * E + 16 * j), r[j]);
+        }
+    }
+    return blocks * 16;
+}
+#endif
+
+void Filters::deltaEncode(vector<uint8_t>& data, int stride) {
+    uint8_t* p = data.data();
+    size_t s = stride;
+    size_t i = data.size();
+
+    // Walk backwards so every byte is read before it is overwritten
+#ifdef __SSE2__
+    while (i >= s + 16) {
+        i -= 16;
+        __m128i current = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i previous = _mm_loadu_si128((const __m128i*)(p + i - s));
+        _mm_storeu_si128((__m128i*)(p + i), _mm_sub_epi8(current, previous));
+    }
+#endif
+    while (i > s) {
+        i--;
+        p[i] -= p[i - s];
+    }
+}
+
+void Filters::deltaDecode(vector<uint8_t>& data, int stride) {
+    uint8_t* p = data.data();
+    size_t n = data.size();
+    size_t s = stride;
+    size_t i = s;
+
+#ifdef __SSE2__
+    if (s >= 16) {
+        // The source bytes of a whole vector are already decoded
+        for (; i + 16 <= n; i += 16) {
+            __m128i current = _mm_loadu_si128((const __m128i*)(p + i));
+            __m128i previous = _mm_loadu_si128((const __m128i*)(p + i - s));
+            _mm_storeu_si128((__m128i*)(p + i), _mm_add_epi8(current, previous));
+        }
+    } else if (s == 1) {
+        deltaDecodeSSE2<1>(p, n, i);
+    } else if (s == 2) {
+        deltaDecodeSSE2<2>(p, n, i);
+    } else if (s == 4) {
+        deltaDecodeSSE2<4>(p, n, i);
+    } else if (s == 8) {
+        deltaDecodeSSE2<8>(p, n, i);
+    }
+#endif
+    for (; i < n; i++) {
+        p[i] += p[i - s];
+    }
+}
+
+void Filters::shuffle(const vector<uint8_t>& input, vector<uint8_t>& output, int elementSize) {
+    size_t e = elementSize;
+    size_t elements = input.size() / e;
+    output.resize(input.size());
+    const uint8_t* src = input.data();
+    uint8_t* dst = output.data();
+
+    size_t done = 0;
+#ifdef __SSE2__
+    if (e == 2) done = shuffleSSE2<2>(src, dst, elements);
+    if (e == 4) done = shuffleSSE2<4>(src, dst, elements);
+    if (e == 8) done = shuffleSSE2<8>(src, dst, elements);
+#endif
+    for (size_t i = done; i < elements; i++) {
+        for (size_t b = 0; b < e; b++) {
+            dst[b * elements + i] = src[i * e + b];
+        }
+    }
+    copy(input.begin() + elements * e, input.end(), output.begin() + elements * e);
+}
+
+void Filters::unshuffle(const vector<uint8_t>& input, vector<uint8_t>& output, int elementSize) {
+    size_t e = elementSize;
+    size_t elements = input.size() / e;
+    output.resize(input.size());
+    const uint8_t* src = input.data();
+    uint8_t* dst = output.data();
+
+    size_t done = 0;
+#ifdef __SSE2__
+    if (e == 2) done = unshuffleSSE2<2>(src, dst, elements);
+    if (e == 4) done = unshuffleSSE2<4>(src, dst, elements);
+    if (e == 8) done = unshuffleSSE2<8>(src, dst, elements);
+#endif
+    for (size_t i = done; i < elements; i++) {
+        for (size_t b = 0; b < e; b++) {
+            dst[i * e + b] = src[b * elements + i];
+        }
+    }
+    copy(input.begin() + elements * e, input.end(), output.begin() + elements * e);
+}
+
+// Shared by both directions. A branch is converted only when the top byte
+// of its 32-bit target is 0x00 or 0xFF, and the result is written back with
+// the same property (bit 24 sign-extended), so the conversion is exact
+// modulo 2^25. A branch within 3 bytes of a rejected candidate is left
+// alone: converting it would rewrite the byte that candidate was judged
+// on, and the decoder would then judge it differently.
+static void x86Convert(vector<uint8_t>& data, bool encoding) {
+    uint8_t* p = data.data();
+    size_t n = data.size();
+    if (n < 5) return;
+    size_t limit = n - 4;
+
+    size_t i = 0;
+    size_t lastRejected = 0;
+    bool rejected = false;
+    while (i < limit) {
+#ifdef __SSE2__
+        // Skip 16 bytes at a time until an E8/E9 opcode shows up
+        if (i + 16 <= limit) {
+            __m128i bytes = _mm_loadu_si128((const __m128i*)(p + i));
+            __m128i opcode = _mm_cmpeq_epi8(_mm_and_si128(bytes, _mm_set1_epi8((char)0xFE)),
+                                            _mm_set1_epi8((char)0xE8));
+            int mask = _mm_movemask_epi8(opcode);
+            if (mask == 0) {
+                i += 16;
+                continue;
+            }
+            i += __builtin_ctz(mask);
+        } else
+#endif
+        if ((p[i] & 0xFE) != 0xE8) {
+            i++;
+            continue;
+        }
+
+        if ((p[i + 4] != 0x00 && p[i + 4] != 0xFF) || (rejected && i - lastRejected <= 3)) {
+            lastRejected = i;
+            rejected = true;
+            i++;
+            continue;
+        }
+
+        uint32_t target = p[i + 1] | (p[i + 2] << 8) | (p[i + 3] << 16) | ((uint32_t)p[i + 4] << 24);
+        uint32_t next = i + 5;
+        target = encoding ? target + next : target - next;
+
+        p[i + 1] = target;
+        p[i + 2] = target >> 8;
+        p[i + 3] = target >> 16;
+        p[i + 4] = (target >> 24) & 1 ? 0xFF : 0x00;
+        i += 5;
+    }
+}
+
+void Filters::x86Encode(vector<uint8_t>& data) {
+    x86Convert(data, true);
+}
+
+void Filters::x86Decode(vector<uint8_t>& data) {
+    x86Convert(data, false);
+}
@@ -1,7 +1,10 @@
 #include "lz77.h"
+#include "lz_token_decoder.h"
+#include "cpu_dispatch.h"
 
 using namespace std;
 
+HOT_MULTIVERSION
 LZ77::Match LZ77::findLongestMatch(const vector<uint8_t>& data, int pos) {
     Match bestMatch;
     
@@ -9,7 +12,9 @@ LZ77::Match LZ77::findLongestMatch(const vector<uint8_t>& data, int pos) {
         bestMatch.nextChar = data[pos];
     }
     
-    int searchStart = max(0, pos - WINDOW_SIZE);
+    // Offsets are stored in 12 bits, so the farthest reachable byte is
+    // WINDOW_SIZE - 1 positions back
+    int searchStart = max(0, pos - (WINDOW_SIZE - 1));
     int maxLength = min(LOOKAHEAD_SIZE, (int)data.size() - pos);
     
     for (int i = searchStart; i < pos; i++) {
@@ -34,57 +39,64 @@ LZ77::Match LZ77::findLongestMatch(const vector<uint8_t>& data, int pos) {
 
 vector<uint8_t> LZ77::compress(const vector<uint8_t>& data) {
     vector<uint8_t> compressed;
+    compressed.reserve(maxCompressedSize(data.size()));
     BitWriter writer(compressed);
+    writer.writeBits(data.size(), 32);
     
-    int pos = 0;
+    size_t pos = 0;
     while (pos < data.size()) {
-        Match match = findLongestMatch(data, pos);
-        
-        if (match.length >= MIN_MATCH_LENGTH) {
-            // Write match flag (1), offset (12 bits), length (4 bits)
-            writer.writeBits(1, 1);
-            writer.writeBits(match.offset, 12);
-            writer.writeBits(match.length - MIN_MATCH_LENGTH, 4);
-            pos += match.length;
-        } else {
-            // Write literal flag (0) and character (8 bits)
-            writer.writeBits(0, 1);
-            writer.writeBits(data[pos], 8);
-            pos++;
+        if (progress.encodeChunk) {
+            progress.encodeChunk(data.data(), pos, writer.bitPosition());
+        }
+        size_t chunkEnd = progress.encodeChunk ? min(data.size(), pos + progress.interval)
+                                               : data.size();
+        while (pos < chunkEnd) {
+            Match match = findLongestMatch(data, pos);
+            
+            if (match.length >= MIN_MATCH_LENGTH) {
+                // Write match flag (1), offset (12 bits), length (4 bits)
+                writer.writeBits(1, 1);
+                writer.writeBits(match.offset, LZTokenDecoder::OFFSET_BITS);
+                writer.writeBits(match.length - MIN_MATCH_LENGTH, LENGTH_BITS);
+                pos += match.length;
+            } else {
+                // Write literal flag (0) and character (8 bits)
+                writer.writeBits(0, 1);
+                writer.writeBits(data[pos], 8);
+                pos++;
+            }
         }
     }
+    if (progress.encodeChunk) {
+        progress.encodeChunk(data.data(), pos, writer.bitPosition());
+    }
     
     writer.flush();
     return compressed;
 }
 
 vector<uint8_t> LZ77::decompress(const vector<uint8_t>& compressed) {
-    vector<uint8_t> decompressed;
-    BitReader reader(compressed);
+    return decompressRange(compressed.data(), compressed.size());
+}
+
+vector<uint8_t> LZ77::decompressRange(const uint8_t* compressed, size_t compressedSize) {
+    if (compressedSize < 4) {
+        throw runtime_error("Corrupt LZ77 stream: truncated header");
+    }
     
-    while (reader.hasMoreBits()) {
-        uint32_t flag = reader.readBits(1);
-        
-        if (flag == 1) {
-            // Match
-            uint32_t offset = reader.readBits(12);
-            uint32_t length = reader.readBits(4) + MIN_MATCH_LENGTH;
-            
-            if (offset > 0 && offset <= decompressed.size()) {
-                int startPos = decompressed.size() - offset;
-                for (int i = 0; i < length; i++) {
-                    if (startPos + i < decompressed.size()) {
-                        decompressed.push_back(decompressed[startPos + i]);
-                    }
-                }
-            }
-        } else {
-            // Literal
-            if (reader.hasMoreBits()) {
-                uint32_t character = reader.readBits(8);
-                decompressed.push_back(character);
-            }
-        }
+    BitReader reader(compressed, compressedSize);
+    size_t size = reader.readBits(32);
+    if (boundsChecked && size > maxDecompressedSize(compressedSize)) {
+        throw runtime_error("Corrupt LZ77 stream: invalid size");
+    }
+    
+    vector<uint8_t> decompressed(size);
+    if (boundsChecked) {
+        LZTokenDecoder::decodeStream<true>(reader, LENGTH_BITS, decompressed.data(), size, "LZ77",
+                                           progress);
+    } else {
+        LZTokenDecoder::decodeStream<false>(reader, LENGTH_BITS, decompressed.data(), size, "LZ77",
+                                            progress);
     }
     
     return decompressed;
@@ -92,4 +104,19 @@ vector<uint8_t> LZ77::decompress(const vector<uint8_t>& compressed) {
 
 string LZ77::getName() const {
     return "LZ77";
-}
\ No newline at end of file
+}
+
+size_t LZ77::maxCompressedSize(size_t inputSize) {
+    return 4 + (inputSize * 9 + 7) / 8;
+}
+
+size_t LZ77::maxDecompressedSize(size_t compressedSize) {
+    // The densest token is a 17-bit match producing 18 bytes
+    size_t tokenBits = compressedSize > 4 ? (compressedSize - 4) * 8 : 0;
+    return tokenBits / 17 * (15 + MIN_MATCH_LENGTH) + 1;
+}
+
+MemoryRequirements LZ77::memoryRequirements(size_t inputSize) const {
+    // Only the output buffers: the match search scans the input itself
+    return {maxCompressedSize(inputSize), inputSize};
+}
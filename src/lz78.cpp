@@ -2,91 +2,225 @@
 
 using namespace std;
 
+LZ78::LZ78(size_t workingStateBudget)
+    : dictBits(MAX_DICT_BITS), workingStateBudget(workingStateBudget) {
+    if (workingStateBudget == 0) return;
+
+    // Largest dictionary whose compress and decompress state both fit
+    auto workingBytes = [](int bits) {
+        return max(compressWorkingBytes(bits), decompressWorkingBytes(bits));
+    };
+    while (dictBits > MIN_DICT_BITS && workingBytes(dictBits) > workingStateBudget) {
+        dictBits--;
+    }
+    if (workingBytes(dictBits) > workingStateBudget) {
+        throw invalid_argument("LZ78: working-state budget of " + to_string(workingStateBudget) +
+                               " bytes is below the smallest dictionary (" +
+                               to_string(workingBytes(MIN_DICT_BITS)) + " bytes)");
+    }
+}
+
+size_t LZ78::compressWorkingBytes(int bits) {
+    return trieCapacity(bits) * sizeof(TrieSlot);
+}
+
+size_t LZ78::decompressWorkingBytes(int bits) {
+    return ((size_t)1 << bits) * sizeof(DictEntry);
+}
+
+size_t LZ78::maxCompressedSize(size_t inputSize, int dictBits) {
+    // Header, then at most one (index, character) pair per input byte
+    return 5 + (inputSize * (dictBits + 8) + 7) / 8;
+}
+
+size_t LZ78::maxDecompressedSize(size_t compressedSize, int dictBits) {
+    // Entry k is at most k bytes long, so token t emits at most t bytes
+    // plus its character
+    size_t tokens = compressedSize > 5 ? (compressedSize - 5) * 8 / dictBits : 0;
+    return tokens * (min(tokens, (size_t)1 << dictBits) + 1);
+}
+
 vector<uint8_t> LZ78::compress(const vector<uint8_t>& data) {
     vector<uint8_t> compressed;
+    compressed.reserve(maxCompressedSize(data.size(), dictBits));
     BitWriter writer(compressed);
-    
-    vector<DictEntry> dictionary;
-    dictionary.push_back(DictEntry()); // Index 0 is empty
-    
-    unordered_map<string, int> stringToIndex;
-    
-    int pos = 0;
+    writer.writeBits(dictBits, 8);
+    writer.writeBits(data.size(), 32);
+
+    // The dictionary is a trie stored as a hash table from
+    // (parent index, next byte) to child index. Index 0 is the empty string.
+    vector<TrieSlot> trie(trieCapacity(dictBits), TrieSlot{0, 0});
+    size_t mask = trie.size() - 1;
+    int hashShift = 32 - (dictBits + 1);
+    size_t dictSize = 1;
+    size_t dictLimit = (size_t)1 << dictBits;
+
+    size_t pos = 0;
+    size_t nextChunk = progress.encodeChunk ? 0 : SIZE_MAX;
     while (pos < data.size()) {
-        string current;
-        int lastIndex = 0;
-        
+        if (pos >= nextChunk) {
+            progress.encodeChunk(data.data(), pos, writer.bitPosition());
+            nextChunk = pos + progress.interval;
+        }
+        uint32_t lastIndex = 0;
+        size_t slot = 0;
+
         // Find longest match in dictionary
         while (pos < data.size()) {
-            current += static_cast<char>(data[pos]);
-            auto it = stringToIndex.find(current);
-            if (it != stringToIndex.end()) {
-                lastIndex = it->second;
-                pos++;
-            } else {
-                break;
+            uint32_t key = ((lastIndex << 8) | data[pos]) + 1;
+            slot = (key * 2654435761u) >> hashShift;
+            while (trie[slot].key != 0 && trie[slot].key != key) {
+                slot = (slot + 1) & mask;
             }
+            if (trie[slot].key == 0) break;
+
+            lastIndex = trie[slot].child;
+            pos++;
         }
-        
+
         // Output: index + character
-        writer.writeBits(lastIndex, 16); // Dictionary index
+        writer.writeBits(lastIndex, dictBits); // Dictionary index
         if (pos < data.size()) {
             writer.writeBits(data[pos], 8); // Next character
-            
-            // Add new entry to dictionary if not full
-            if (dictionary.size() < MAX_DICT_SIZE) {
-                dictionary.push_back(DictEntry(lastIndex, data[pos]));
-                stringToIndex[current] = dictionary.size() - 1;
+
+            // Add new entry to dictionary if not full; slot is the empty
+            // slot where the probe for this key stopped
+            if (dictSize < dictLimit) {
+                trie[slot] = TrieSlot{((lastIndex << 8) | data[pos]) + 1, (uint32_t)dictSize++};
             }
             pos++;
-        } else {
-            writer.writeBits(0, 8); // End marker
         }
     }
-    
+    if (progress.encodeChunk) {
+        progress.encodeChunk(data.data(), pos, writer.bitPosition());
+    }
+
     writer.flush();
     return compressed;
 }
 
-vector<uint8_t> LZ78::decompress(const vector<uint8_t>& compressed) {
-    vector<uint8_t> decompressed;
-    BitReader reader(compressed);
-    
-    vector<string> dictionary;
-    dictionary.push_back(""); // Index 0 is empty
-    
-    while (reader.hasMoreBits()) {
-        uint32_t index = reader.readBits(16);
-        if (!reader.hasMoreBits()) break;
-        
-        uint32_t character = reader.readBits(8);
-        
-        // Handle end of data
-        if (character == 0 && index == 0) break;
-        
-        string entry;
-        if (index < dictionary.size()) {
-            entry = dictionary[index];
-        }
-        
-        if (character != 0) {
-            entry += static_cast<char>(character);
-            
-            // Add new entry to dictionary if not full
-            if (dictionary.size() < MAX_DICT_SIZE) {
-                dictionary.push_back(entry);
+template <bool Checked>
+void LZ78::decodeTokens(BitReader& reader, int bits, vector<uint8_t>& output,
+                        size_t size) const {
+    size_t dictLimit = (size_t)1 << bits;
+    vector<DictEntry> dictionary;
+    dictionary.reserve(dictLimit);
+    dictionary.push_back(DictEntry()); // Index 0 is empty
+
+    size_t pos = 0;
+    bool chunked = progress.decodeChunk || progress.outputFinal;
+    size_t nextChunk = chunked ? 0 : SIZE_MAX;
+    while (pos < size) {
+        if (pos >= nextChunk) {
+            if (pos > 0 && progress.outputFinal) {
+                progress.outputFinal(output.data(), pos);
+            }
+            if (progress.decodeChunk) {
+                progress.decodeChunk(pos, reader.bitPosition());
             }
+            nextChunk = pos + progress.interval;
         }
-        
-        // Output the string
-        for (char c : entry) {
-            decompressed.push_back(static_cast<uint8_t>(c));
+
+        if (Checked && reader.bitsRemaining() < (size_t)bits) {
+            throw runtime_error("Corrupt LZ78 stream: truncated data");
+        }
+        uint32_t index = reader.readBits(bits);
+        if (Checked && index >= dictionary.size()) {
+            throw runtime_error("Corrupt LZ78 stream: invalid dictionary index");
+        }
+
+        // Write the entry back to front by following its parent chain
+        const DictEntry& entry = dictionary[index];
+        if (Checked && entry.length > size - pos) {
+            throw runtime_error("Corrupt LZ78 stream: output overflow");
+        }
+        size_t length = entry.length;
+        if (pos + length + 1 > output.capacity()) {
+            // Grow explicitly, never past the stored size
+            output.reserve(min(size, max(pos + length + 1, output.capacity() * 2)));
+        }
+        output.resize(pos + length);
+        uint8_t* out = output.data();
+        for (int i = index; i > 0; i = dictionary[i].parent) {
+            out[pos + dictionary[i].length - 1] = dictionary[i].character;
+        }
+        pos += length;
+        if (pos == size) break;
+
+        if (Checked && reader.bitsRemaining() < 8) {
+            throw runtime_error("Corrupt LZ78 stream: truncated data");
         }
+        uint8_t character = reader.readBits(8);
+        output.push_back(character);
+        pos++;
+
+        // Add new entry to dictionary if not full
+        if (dictionary.size() < dictLimit) {
+            dictionary.push_back(DictEntry(index, length + 1, character));
+        }
+    }
+    if (progress.outputFinal && pos > 0) {
+        progress.outputFinal(output.data(), pos);
+    }
+
+    // Only the zero padding of the final byte may remain
+    if (Checked && reader.bitsRemaining() >= 8) {
+        throw runtime_error("Corrupt LZ78 stream: trailing data");
+    }
+    if (Checked && reader.readBits(reader.bitsRemaining()) != 0) {
+        throw runtime_error("Corrupt LZ78 stream: nonzero padding");
     }
-    
+}
+
+vector<uint8_t> LZ78::decompress(const vector<uint8_t>& compressed) {
+    return decompressRange(compressed.data(), compressed.size());
+}
+
+vector<uint8_t> LZ78::decompressRange(const uint8_t* compressed, size_t compressedSize) {
+    if (compressedSize < 5) {
+        throw runtime_error("Corrupt LZ78 stream: truncated header");
+    }
+
+    BitReader reader(compressed, compressedSize);
+    int bits = reader.readBits(8);
+    if (bits < MIN_DICT_BITS || bits > MAX_DICT_BITS) {
+        throw runtime_error("Corrupt LZ78 stream: invalid dictionary width");
+    }
+    if (workingStateBudget != 0 && decompressWorkingBytes(bits) > workingStateBudget) {
+        throw runtime_error("LZ78: " + to_string((size_t)1 << bits) + "-entry dictionary needs " +
+                            to_string(decompressWorkingBytes(bits)) +
+                            " bytes, over the working-state budget of " +
+                            to_string(workingStateBudget) + " bytes");
+    }
+    size_t size = reader.readBits(32);
+    if (boundsChecked && size > maxDecompressedSize(compressedSize, bits)) {
+        throw runtime_error("Corrupt LZ78 stream: invalid size");
+    }
+
+    // The size bound above grows quadratically with the stream, so a
+    // checked decode does not allocate from the stored size: it starts at a
+    // multiple of the stream size and grows as tokens decode, and a forged
+    // size runs out of tokens before it runs out of memory
+    vector<uint8_t> decompressed;
+    if (boundsChecked) {
+        decompressed.reserve(min(size, compressedSize * CHECKED_RESERVE_RATIO));
+        decodeTokens<true>(reader, bits, decompressed, size);
+    } else {
+        decompressed.reserve(size);
+        decodeTokens<false>(reader, bits, decompressed, size);
+    }
+
     return decompressed;
 }
 
 string LZ78::getName() const {
     return "LZ78";
-}
\ No newline at end of file
+}
+
+MemoryRequirements LZ78::memoryRequirements(size_t inputSize) const {
+    // A checked decode grows its output up to the stored size, so its last
+    // reallocation holds a smaller old buffer next to the full-size one
+    size_t outputBytes = boundsChecked ? 2 * inputSize : inputSize;
+    return {maxCompressedSize(inputSize, dictBits) + compressWorkingBytes(dictBits),
+            outputBytes + decompressWorkingBytes(dictBits)};
+}
@@ -0,0 +1,44 @@
+#include "lz_token_decoder.h"
+
+using namespace std;
+
+void LZTokenDecoder::fail(const char* name, const char* problem) {
+    throw runtime_error(string("Corrupt ") + name + " stream: " + problem);
+}
+
+void LZTokenDecoder::checkEnd(BitReader& reader, const char* name) {
+    if (reader.bitsRemaining() >= 8) {
+        fail(name, "trailing data");
+    }
+    if (reader.readBits(reader.bitsRemaining()) != 0) {
+        fail(name, "nonzero padding");
+    }
+}
+
+template <bool Checked>
+void LZTokenDecoder::decodeStream(BitReader& reader, int lengthBits, uint8_t* output,
+                                  size_t size, const char* name,
+                                  const CompressionAlgorithm::ProgressHooks& progress) {
+    auto copyAll = [](size_t, size_t, size_t) { return false; };
+    bool chunked = progress.decodeChunk || progress.outputFinal;
+    size_t pos = 0;
+    while (pos < size) {
+        if (progress.decodeChunk) {
+            progress.decodeChunk(pos, reader.bitPosition());
+        }
+        size_t chunkEnd = chunked ? min(size, pos + progress.interval) : size;
+        pos = decode<Checked>(reader, lengthBits, output, pos, chunkEnd, size, 0, name, copyAll);
+        if (progress.outputFinal) {
+            progress.outputFinal(output, pos);
+        }
+    }
+
+    if (Checked) {
+        checkEnd(reader, name);
+    }
+}
+
+template void LZTokenDecoder::decodeStream<true>(BitReader&, int, uint8_t*, size_t, const char*,
+                                                 const CompressionAlgorithm::ProgressHooks&);
+template void LZTokenDecoder::decodeStream<false>(BitReader&, int, uint8_t*, size_t, const char*,
+                                                  const CompressionAlgorithm::ProgressHooks&);
@@ -1,17 +1,22 @@
 #include "lzss.h"
+#include "lz_token_decoder.h"
+#include "cpu_dispatch.h"
 
 using namespace std;
 
-LZSS::Match LZSS::findLongestMatch(const vector<uint8_t>& data, int pos) {
+HOT_MULTIVERSION
+LZSS::Match LZSS::findLongestMatch(const vector<uint8_t>& data, int pos,
+                                   int historyStart, int end) {
     Match bestMatch;
     
-    int searchStart = max(0, pos - WINDOW_SIZE);
-    int maxLength = min(LOOKAHEAD_SIZE, (int)data.size() - pos);
+    // Offsets are stored in 12 bits, so the farthest reachable byte is
+    // WINDOW_SIZE - 1 positions back
+    int searchStart = max(historyStart, pos - (WINDOW_SIZE - 1));
+    int maxLength = min(LOOKAHEAD_SIZE, end - pos);
     
     for (int i = searchStart; i < pos; i++) {
         int length = 0;
         while (length < maxLength && 
-               pos + length < data.size() && 
                data[i + length] == data[pos + length]) {
             length++;
         }
@@ -35,19 +40,17 @@ bool LZSS::isMatchBeneficial(const Match& match) {
     return matchBits < literalBits;
 }
 
-vector<uint8_t> LZSS::compress(const vector<uint8_t>& data) {
-    vector<uint8_t> compressed;
-    BitWriter writer(compressed);
-    
-    int pos = 0;
-    while (pos < data.size()) {
-        Match match = findLongestMatch(data, pos);
+int LZSS::encodeRange(BitWriter& writer, const vector<uint8_t>& data,
+                      int begin, int stopAt, int end, int historyStart) {
+    int pos = begin;
+    while (pos < stopAt) {
+        Match match = findLongestMatch(data, pos, historyStart, end);
         
         if (match.length >= MIN_MATCH_LENGTH && isMatchBeneficial(match)) {
             // Write match: flag(1) + offset(12) + length(5)
             writer.writeBits(1, 1);
-            writer.writeBits(match.offset, 12);
-            writer.writeBits(match.length - MIN_MATCH_LENGTH, 5);
+            writer.writeBits(match.offset, LZTokenDecoder::OFFSET_BITS);
+            writer.writeBits(match.length - MIN_MATCH_LENGTH, LENGTH_BITS);
             pos += match.length;
         } else {
             // Write literal: flag(0) + character(8)
@@ -56,38 +59,54 @@ vector<uint8_t> LZSS::compress(const vector<uint8_t>& data) {
             pos++;
         }
     }
+    return pos;
+}
+
+vector<uint8_t> LZSS::compress(const vector<uint8_t>& data) {
+    vector<uint8_t> compressed;
+    compressed.reserve(maxCompressedSize(data.size()));
+    BitWriter writer(compressed);
+    
+    writer.writeBits(data.size(), 32);
+    int size = data.size();
+    int pos = 0;
+    while (pos < size) {
+        if (progress.encodeChunk) {
+            progress.encodeChunk(data.data(), pos, writer.bitPosition());
+        }
+        int chunkEnd = progress.encodeChunk ? min<size_t>(size, pos + progress.interval) : size;
+        pos = encodeRange(writer, data, pos, chunkEnd, size, 0);
+    }
+    if (progress.encodeChunk) {
+        progress.encodeChunk(data.data(), pos, writer.bitPosition());
+    }
     
     writer.flush();
     return compressed;
 }
 
 vector<uint8_t> LZSS::decompress(const vector<uint8_t>& compressed) {
-    vector<uint8_t> decompressed;
-    BitReader reader(compressed);
+    return decompressRange(compressed.data(), compressed.size());
+}
+
+vector<uint8_t> LZSS::decompressRange(const uint8_t* compressed, size_t compressedSize) {
+    if (compressedSize < 4) {
+        throw runtime_error("Corrupt LZSS stream: truncated header");
+    }
     
-    while (reader.hasMoreBits()) {
-        uint32_t flag = reader.readBits(1);
-        
-        if (flag == 1) {
-            // Match
-            uint32_t offset = reader.readBits(12);
-            uint32_t length = reader.readBits(5) + MIN_MATCH_LENGTH;
-            
-            if (offset > 0 && offset <= decompressed.size()) {
-                int startPos = decompressed.size() - offset;
-                for (int i = 0; i < length; i++) {
-                    if (startPos + i < decompressed.size()) {
-                        decompressed.push_back(decompressed[startPos + i]);
-                    }
-                }
-            }
-        } else {
-            // Literal
-            if (reader.hasMoreBits()) {
-                uint32_t character = reader.readBits(8);
-                decompressed.push_back(character);
-            }
-        }
+    BitReader reader(compressed, compressedSize);
+    size_t size = reader.readBits(32);
+    if (boundsChecked && size > maxDecompressedSize(compressedSize)) {
+        throw runtime_error("Corrupt LZSS stream: invalid size");
+    }
+    
+    vector<uint8_t> decompressed(size);
+    if (boundsChecked) {
+        LZTokenDecoder::decodeStream<true>(reader, LENGTH_BITS, decompressed.data(), size, "LZSS",
+                                           progress);
+    } else {
+        LZTokenDecoder::decodeStream<false>(reader, LENGTH_BITS, decompressed.data(), size, "LZSS",
+                                            progress);
     }
     
     return decompressed;
@@ -95,4 +114,28 @@ vector<uint8_t> LZSS::decompress(const vector<uint8_t>& compressed) {
 
 string LZSS::getName() const {
     return "LZSS";
-}
\ No newline at end of file
+}
+
+size_t LZSS::maxPayloadSize(size_t inputSize) {
+    return (inputSize * 9 + 7) / 8;
+}
+
+size_t LZSS::maxCompressedSize(size_t inputSize) {
+    return 4 + maxPayloadSize(inputSize);
+}
+
+size_t LZSS::maxPayloadOutput(size_t payloadSize) {
+    // The densest token is an 18-bit match whose 5-bit length field can
+    // describe up to 34 bytes
+    return payloadSize * 8 / 18 * (31 + MIN_MATCH_LENGTH) + 1;
+}
+
+size_t LZSS::maxDecompressedSize(size_t compressedSize) {
+    return maxPayloadOutput(compressedSize > 4 ? compressedSize - 4 : 0);
+}
+
+MemoryRequirements LZSS::memoryRequirements(size_t inputSize) const {
+    // No match-finder state: the search runs directly over the input. Both
+    // directions allocate their output once, at its worst case.
+    return {maxCompressedSize(inputSize), inputSize};
+}
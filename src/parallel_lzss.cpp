@@ -0,0 +1,315 @@
+#include "parallel_lzss.h"
+#include "lz_token_decoder.h"
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+ParallelLZSS::ParallelLZSS(int blockSize, unsigned threads, bool crossBlockHistory,
+                           size_t workingStateBudget)
+    : blockSize(max(blockSize, 1)), threadCount(threads),
+      crossBlockHistory(crossBlockHistory), workingStateBudget(workingStateBudget) {
+    if (threadCount == 0) {
+        threadCount = max(1u, thread::hardware_concurrency());
+    }
+    if (workingStateBudget == 0) return;
+
+    // Decoding holds more per block than encoding, so it sets the limit
+    auto inFlightBytes = [this]() {
+        return threadCount * decompressBlockBytes(this->blockSize);
+    };
+    while (inFlightBytes() > workingStateBudget && this->blockSize / 2 >= MIN_BUDGET_BLOCK_SIZE) {
+        this->blockSize /= 2;
+    }
+    while (inFlightBytes() > workingStateBudget && threadCount > 1) {
+        threadCount--;
+    }
+    if (inFlightBytes() > workingStateBudget) {
+        throw invalid_argument("LZSS-Parallel: working-state budget of " +
+                               to_string(workingStateBudget) + " bytes is below one " +
+                               to_string(this->blockSize) + " byte block in flight (" +
+                               to_string(inFlightBytes()) + " bytes)");
+    }
+}
+
+size_t ParallelLZSS::compressBlockBytes(size_t blockSize) {
+    return LZSS::maxPayloadSize(blockSize);
+}
+
+size_t ParallelLZSS::decompressBlockBytes(size_t blockSize) {
+    // The pending list holds at most one entry per match. It grows up to
+    // that, so its last reallocation holds a smaller old list next to it.
+    return 2 * (blockSize / LZSS::MIN_MATCH_LENGTH) * sizeof(PendingMatch);
+}
+
+size_t ParallelLZSS::maxCompressedSize(size_t inputSize, int blockSize) {
+    size_t fullBlocks = inputSize / blockSize;
+    size_t tail = inputSize % blockSize;
+    size_t blockCount = fullBlocks + (tail > 0 ? 1 : 0);
+    return 4 + blockCount * 8 + fullBlocks * LZSS::maxPayloadSize(blockSize) +
+           LZSS::maxPayloadSize(tail);
+}
+
+size_t ParallelLZSS::blocksInFlight(size_t blockCount) const {
+    return workingStateBudget != 0 ? min<size_t>(threadCount, blockCount) : blockCount;
+}
+
+void ParallelLZSS::runParallel(size_t count, const function<void(size_t)>& task) const {
+    size_t workers = min<size_t>(threadCount, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // Workers pull block indices from a shared counter so uneven blocks
+    // balance out; the first exception raised by any worker is rethrown
+    atomic<size_t> next(0);
+    exception_ptr error;
+    atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        size_t i;
+        while (!failed && (i = next++) < count) {
+            try {
+                task(i);
+            } catch (...) {
+                if (!failed.exchange(true)) {
+                    error = current_exception();
+                }
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (size_t t = 1; t < workers; t++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (thread& th : pool) {
+        th.join();
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+// Writes a 32-bit header field in place, MSB first like BitWriter
+static void putUint32(vector<uint8_t>& out, size_t pos, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[pos + i] = value >> (24 - 8 * i);
+    }
+}
+
+vector<uint8_t> ParallelLZSS::compress(const vector<uint8_t>& data) {
+    size_t blockCount = (data.size() + blockSize - 1) / blockSize;
+    vector<uint8_t> compressed;
+    compressed.reserve(maxCompressedSize(data.size(), blockSize));
+    compressed.resize(4 + blockCount * 8);
+    putUint32(compressed, 0, blockCount);
+
+    // Under a memory budget blocks are processed in waves of threadCount so
+    // only one wave of payloads is buffered at a time; otherwise all blocks
+    // form a single wave. Every worker sees the whole input, so the preset
+    // dictionary of a block is the tail of the previous block read in place.
+    LZSS lzss;
+    vector<vector<uint8_t>> payloads(blocksInFlight(blockCount));
+    for (vector<uint8_t>& payload : payloads) {
+        payload.reserve(compressBlockBytes(min<size_t>(blockSize, data.size())));
+    }
+
+    for (size_t waveStart = 0; waveStart < blockCount; waveStart += payloads.size()) {
+        size_t waveSize = min(payloads.size(), blockCount - waveStart);
+        runParallel(waveSize, [&](size_t w) {
+            size_t i = waveStart + w;
+            int begin = i * blockSize;
+            int end = min<size_t>(data.size(), begin + (size_t)blockSize);
+            int historyStart = crossBlockHistory ? max(0, begin - LZSS::WINDOW_SIZE) : begin;
+
+            payloads[w].clear();
+            BitWriter writer(payloads[w]);
+            lzss.encodeRange(writer, data, begin, end, end, historyStart);
+            writer.flush();
+        });
+
+        for (size_t w = 0; w < waveSize; w++) {
+            size_t i = waveStart + w;
+            size_t rawSize = min<size_t>(blockSize, data.size() - i * blockSize);
+            putUint32(compressed, 4 + i * 8, rawSize);
+            putUint32(compressed, 8 + i * 8, payloads[w].size());
+            if (progress.encodeChunk) {
+                progress.encodeChunk(data.data(), i * blockSize, compressed.size() * 8);
+            }
+            compressed.insert(compressed.end(), payloads[w].begin(), payloads[w].end());
+        }
+    }
+    if (progress.encodeChunk) {
+        progress.encodeChunk(data.data(), data.size(), compressed.size() * 8);
+    }
+
+    return compressed;
+}
+
+template <bool Checked>
+vector<ParallelLZSS::PendingMatch> ParallelLZSS::decodeBlock(const uint8_t* payload,
+                                                             size_t payloadSize,
+                                                             vector<uint8_t>& output,
+                                                             size_t blockStart, size_t blockEnd,
+                                                             bool hasHistory) const {
+    // Pending matches are few and sorted by position, so a match only needs
+    // a search when its source starts before the end of the last one
+    vector<PendingMatch> pending;
+    size_t pendingEnd = blockStart;
+    auto sourcePending = [&](size_t src, size_t srcEnd) {
+        if (src < blockStart) return true;
+        if (src >= pendingEnd) return false;
+        auto it = upper_bound(pending.begin(), pending.end(), src - blockStart,
+                              [](size_t offset, const PendingMatch& match) {
+                                  return offset < match.start + match.length;
+                              });
+        return it != pending.end() && it->start < srcEnd - blockStart;
+    };
+
+    // Bytes a match produces itself (offset < length) are final exactly
+    // when the bytes before them are
+    auto deferMatch = [&](size_t pos, uint32_t length, uint32_t offset) {
+        size_t src = pos - offset;
+        if (!sourcePending(src, min<size_t>(src + length, pos))) return false;
+        if (pending.size() == pending.capacity()) {
+            // Grow explicitly, never past one entry per possible match
+            size_t limit = (blockEnd - blockStart) / LZSS::MIN_MATCH_LENGTH;
+            pending.reserve(min(limit, max<size_t>(64, pending.capacity() * 2)));
+        }
+        pending.push_back({(uint32_t)(pos - blockStart), (uint16_t)length, (uint16_t)offset});
+        pendingEnd = pos + length;
+        return true;
+    };
+
+    BitReader reader(payload, payloadSize);
+    size_t historyStart = hasHistory ? 0 : blockStart;
+    LZTokenDecoder::decode<Checked>(reader, LZSS::LENGTH_BITS, output.data(), blockStart,
+                                    blockEnd, blockEnd, historyStart, "LZSS-Parallel",
+                                    deferMatch);
+    if (Checked) {
+        LZTokenDecoder::checkEnd(reader, "LZSS-Parallel");
+    }
+
+    return pending;
+}
+
+vector<uint8_t> ParallelLZSS::decompress(const vector<uint8_t>& compressed) {
+    return decompressRange(compressed.data(), compressed.size());
+}
+
+vector<uint8_t> ParallelLZSS::decompressRange(const uint8_t* compressed, size_t compressedSize) {
+    if (compressedSize < 4) {
+        throw runtime_error("Corrupt LZSS-Parallel stream: truncated header");
+    }
+
+    BitReader header(compressed, compressedSize);
+    uint32_t blockCount = header.readBits(32);
+    size_t headerSize = 4 + (size_t)blockCount * 8;
+    if (compressedSize < headerSize) {
+        throw runtime_error("Corrupt LZSS-Parallel stream: truncated header");
+    }
+
+    vector<BlockInfo> blocks(blockCount);
+    size_t rawStart = 0;
+    size_t payloadStart = headerSize;
+    size_t maxRawSize = 0;
+    for (BlockInfo& block : blocks) {
+        block.rawStart = rawStart;
+        block.rawSize = header.readBits(32);
+        maxRawSize = max<size_t>(maxRawSize, block.rawSize);
+        block.payloadStart = payloadStart;
+        block.payloadSize = header.readBits(32);
+        if (boundsChecked && block.rawSize > LZSS::maxPayloadOutput(block.payloadSize)) {
+            throw runtime_error("Corrupt LZSS-Parallel stream: invalid block size");
+        }
+        rawStart += block.rawSize;
+        payloadStart += block.payloadSize;
+    }
+    if (payloadStart > compressedSize) {
+        throw runtime_error("Corrupt LZSS-Parallel stream: truncated payload");
+    }
+    if (boundsChecked && payloadStart < compressedSize) {
+        throw runtime_error("Corrupt LZSS-Parallel stream: trailing data");
+    }
+
+    // A budgeted decoder holds only as many blocks as fit the budget at
+    // once, and refuses streams whose blocks are too large for even one
+    size_t waveLimit = blockCount;
+    if (workingStateBudget != 0) {
+        size_t blockBytes = decompressBlockBytes(maxRawSize);
+        if (blockBytes > workingStateBudget) {
+            throw runtime_error("LZSS-Parallel: blocks of " + to_string(maxRawSize) +
+                                " bytes need " + to_string(blockBytes) +
+                                " bytes of working state, over the budget of " +
+                                to_string(workingStateBudget) + " bytes");
+        }
+        waveLimit = min<size_t>(threadCount, blockBytes == 0 ? blockCount
+                                                             : workingStateBudget / blockBytes);
+    }
+
+    // Decode in waves (a single wave without a memory budget). Within a
+    // wave every block is decoded concurrently straight out of the stream;
+    // matches that reach into the previous block cannot be resolved yet and
+    // are left pending. They are then replayed in block order: they only
+    // read earlier bytes, which are complete by the time we reach them.
+    vector<uint8_t> decompressed(rawStart);
+    vector<vector<PendingMatch>> pending(min<size_t>(waveLimit, blockCount));
+    for (size_t waveStart = 0; waveStart < blockCount; waveStart += pending.size()) {
+        size_t waveSize = min(pending.size(), blockCount - waveStart);
+        if (progress.decodeChunk) {
+            for (size_t w = 0; w < waveSize; w++) {
+                const BlockInfo& block = blocks[waveStart + w];
+                progress.decodeChunk(block.rawStart, block.payloadStart * 8);
+            }
+        }
+        runParallel(waveSize, [&](size_t w) {
+            const BlockInfo& block = blocks[waveStart + w];
+            const uint8_t* payload = compressed + block.payloadStart;
+            size_t blockEnd = block.rawStart + block.rawSize;
+            bool hasHistory = waveStart + w > 0;
+            pending[w] = boundsChecked
+                ? decodeBlock<true>(payload, block.payloadSize, decompressed, block.rawStart,
+                                    blockEnd, hasHistory)
+                : decodeBlock<false>(payload, block.payloadSize, decompressed, block.rawStart,
+                                     blockEnd, hasHistory);
+        });
+
+        for (size_t w = 0; w < waveSize; w++) {
+            const BlockInfo& block = blocks[waveStart + w];
+            size_t blockStart = block.rawStart;
+            for (const PendingMatch& match : pending[w]) {
+                uint8_t* out = decompressed.data() + blockStart + match.start;
+                for (uint32_t i = 0; i < match.length; i++) {
+                    out[i] = out[(ptrdiff_t)i - match.distance];
+                }
+            }
+            vector<PendingMatch>().swap(pending[w]);
+
+            // The block is final once patched
+            if (progress.outputFinal) {
+                progress.outputFinal(decompressed.data(), blockStart + block.rawSize);
+            }
+        }
+    }
+
+    return decompressed;
+}
+
+string ParallelLZSS::getName() const {
+    return "LZSS-Parallel";
+}
+
+MemoryRequirements ParallelLZSS::memoryRequirements(size_t inputSize) const {
+    size_t blockCount = (inputSize + blockSize - 1) / blockSize;
+    size_t inFlight = blocksInFlight(blockCount);
+    size_t largestBlock = min<size_t>(blockSize, inputSize);
+    return {maxCompressedSize(inputSize, blockSize) + inFlight * compressBlockBytes(largestBlock),
+            inputSize + blockCount * sizeof(BlockInfo) +
+                inFlight * decompressBlockBytes(largestBlock)};
+}